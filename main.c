@@ -4,10 +4,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "rtree.h"
+
 #define WINDOW_WIDTH 1280
 #define WINDOW_HEIGHT 720
 #define TOOLBAR_HEIGHT 70
 #define TOOLBAR_MARGIN 8
+#define DAMAGE_PADDING 2
+#define DOCUMENT_MIN_ZOOM 0.25f
+#define DOCUMENT_MAX_ZOOM 8.0f
+#define DOCUMENT_PAN_STEP 0.25f
 
 static SDL_Window *window = NULL;
 static SDL_Renderer *renderer = NULL;
@@ -15,9 +21,11 @@ static SDL_Texture *canvas_texture = NULL;
 static SDL_Texture *canvas_texture_preview = NULL;
 static SDL_FRect canvas_rect = {0, TOOLBAR_HEIGHT, WINDOW_WIDTH,
                                 WINDOW_HEIGHT - TOOLBAR_HEIGHT};
+static float canvas_density = 1;
 static SDL_Texture *toolbar_texture = NULL;
 static SDL_FRect toolbar_rect = {0, 0, WINDOW_WIDTH, TOOLBAR_HEIGHT};
 static SDL_FRect current_color_rect = {-1, -1, -1, -1};
+static float toolbar_scale = 1;
 
 typedef enum tool { NONE, BRUSH, ERASER, LINE, BOX, FILL } tool;
 typedef enum button_type { TOOL, PALETTE, SIZE } button_type;
@@ -55,8 +63,36 @@ struct GlobalState {
     float ystart;
     bool drag_in_progress;
     bool prev_motion_on_canvas;
+    bool vector_mode;
+};
+
+// vector document: primitives in document units, indexed by an r-tree
+typedef struct Primitive {
+    tool tool;
+    SDL_Color color;
+    float brush_size;
+    SDL_FPoint *points;
+    int point_count;
+    int point_capacity;
+    SDL_FRect bounds;
+    Uint64 id;
+    Uint8 *coverage; // fills: one bit per pixel of bounds when flooded
+    int coverage_w;
+    int coverage_h;
+    SDL_Texture *coverage_texture;
+} Primitive;
+
+struct Document {
+    RTreeNode *root;
+    Primitive *active;
+    Uint64 next_id;
+    float zoom;
+    float scale; // canvas pixels per document unit
+    SDL_FPoint pan; // document point at the canvas' top left corner
 };
 
+struct Document document = {.zoom = 1, .scale = 1};
+
 struct GlobalState state = {.xprev = -1.0f,
                             .yprev = -1.0f,
                             .tool = BRUSH,
@@ -157,12 +193,24 @@ void free_buttons() {
 
 SDL_FPoint *new_point(float x, float y) { return &(SDL_FPoint){x, y}; }
 
+static inline void set_toolbar_target() {
+    SDL_SetRenderTarget(renderer, toolbar_texture);
+    SDL_SetRenderScale(renderer, toolbar_scale, toolbar_scale);
+}
+
 static inline void clear_canvas_preview() {
     SDL_SetRenderTarget(renderer, canvas_texture_preview);
     SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_TRANSPARENT);
     SDL_RenderClear(renderer);
 }
 
+// a line or box being dragged starts at a canvas pixel, which goes stale
+// when the view changes
+static inline void cancel_drag() {
+    state.drag_in_progress = false;
+    clear_canvas_preview();
+}
+
 void render_filled_circle(SDL_Renderer *renderer, int x, int y, int radius) {
     int offsetx = 0;
     int offsety = radius;
@@ -193,14 +241,22 @@ void render_filled_circle(SDL_Renderer *renderer, int x, int y, int radius) {
     }
 }
 
-void tool_line(SDL_Renderer *renderer, SDL_Texture *texture, float x0, float y0,
-               float x1, float y1, bool circle_shape) {
-    SDL_SetRenderTarget(renderer, texture);
+static inline SDL_Color tool_color() {
     if (state.tool == ERASER)
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
-    else
-        SDL_SetRenderDrawColor(renderer, state.color.r, state.color.g,
-                               state.color.b, SDL_ALPHA_OPAQUE);
+        return (SDL_Color){255, 255, 255, SDL_ALPHA_OPAQUE};
+    return state.color;
+}
+
+static inline float canvas_brush_size() {
+    return state.brush_size * document.scale;
+}
+
+void draw_line(SDL_Renderer *renderer, float xstart, float ystart, float xend,
+               float yend, float brush_size, bool circle_shape) {
+    int x0 = SDL_lroundf(xstart);
+    int y0 = SDL_lroundf(ystart);
+    int x1 = SDL_lroundf(xend);
+    int y1 = SDL_lroundf(yend);
 
     int dx = abs(x1 - x0);
     int stepx = x0 < x1 ? 1 : -1;
@@ -210,10 +266,9 @@ void tool_line(SDL_Renderer *renderer, SDL_Texture *texture, float x0, float y0,
 
     while (true) {
         if (circle_shape) {
-            render_filled_circle(renderer, x0, y0, state.brush_size);
+            render_filled_circle(renderer, x0, y0, brush_size);
         } else {
-            SDL_FRect rect = {x0, y0, state.brush_size * 2,
-                              state.brush_size * 2};
+            SDL_FRect rect = {x0, y0, brush_size * 2, brush_size * 2};
             SDL_RenderFillRect(renderer, &rect);
         }
         if (x0 == x1 && y0 == y1)
@@ -230,19 +285,14 @@ void tool_line(SDL_Renderer *renderer, SDL_Texture *texture, float x0, float y0,
     }
 }
 
-void tool_box(SDL_Renderer *renderer, SDL_Texture *texture, float x0, float y0,
-              float x1, float y1) {
-
+void draw_box(SDL_Renderer *renderer, float x0, float y0, float x1, float y1,
+              float brush_size) {
     if (x0 == x1 && y0 == y1)
         return;
-    SDL_SetRenderTarget(renderer, texture);
-    SDL_SetRenderDrawColor(renderer, state.color.r, state.color.g,
-                           state.color.b, SDL_ALPHA_OPAQUE);
 
     SDL_FRect rect;
 
-    if (abs(x1 - x0) < state.brush_size * 4 ||
-        abs(y1 - y0) < state.brush_size * 4) {
+    if (abs(x1 - x0) < brush_size * 4 || abs(y1 - y0) < brush_size * 4) {
         rect = (SDL_FRect){x0, y0, x1 - x0, y1 - y0};
         SDL_RenderFillRect(renderer, &rect);
         return;
@@ -250,130 +300,594 @@ void tool_box(SDL_Renderer *renderer, SDL_Texture *texture, float x0, float y0,
 
     if (x1 > x0) {
         if (y1 > y0) {
-            rect = (SDL_FRect){x0, y0, x1 - x0, state.brush_size * 2};
+            rect = (SDL_FRect){x0, y0, x1 - x0, brush_size * 2};
             SDL_RenderFillRect(renderer, &rect);
-            rect = (SDL_FRect){x0, y1 - state.brush_size * 2, x1 - x0,
-                               state.brush_size * 2};
+            rect = (SDL_FRect){x0, y1 - brush_size * 2, x1 - x0,
+                               brush_size * 2};
             SDL_RenderFillRect(renderer, &rect);
         } else {
-            rect = (SDL_FRect){x0, y0 - state.brush_size * 2, x1 - x0,
-                               state.brush_size * 2};
+            rect = (SDL_FRect){x0, y0 - brush_size * 2, x1 - x0,
+                               brush_size * 2};
             SDL_RenderFillRect(renderer, &rect);
-            rect = (SDL_FRect){x0, y1, x1 - x0, state.brush_size * 2};
+            rect = (SDL_FRect){x0, y1, x1 - x0, brush_size * 2};
             SDL_RenderFillRect(renderer, &rect);
         }
-        rect = (SDL_FRect){x0, y0, state.brush_size * 2, y1 - y0};
+        rect = (SDL_FRect){x0, y0, brush_size * 2, y1 - y0};
         SDL_RenderFillRect(renderer, &rect);
-        rect = (SDL_FRect){x1 - state.brush_size * 2, y0, state.brush_size * 2,
-                           y1 - y0};
+        rect = (SDL_FRect){x1 - brush_size * 2, y0, brush_size * 2, y1 - y0};
         SDL_RenderFillRect(renderer, &rect);
     } else {
         if (y1 > y0) {
-            rect = (SDL_FRect){x0, y0, x1 - x0, state.brush_size * 2};
+            rect = (SDL_FRect){x0, y0, x1 - x0, brush_size * 2};
             SDL_RenderFillRect(renderer, &rect);
-            rect = (SDL_FRect){x0, y1 - state.brush_size * 2, x1 - x0,
-                               state.brush_size * 2};
+            rect = (SDL_FRect){x0, y1 - brush_size * 2, x1 - x0,
+                               brush_size * 2};
             SDL_RenderFillRect(renderer, &rect);
         } else {
-            rect = (SDL_FRect){x0, y0 - state.brush_size * 2, x1 - x0,
-                               state.brush_size * 2};
+            rect = (SDL_FRect){x0, y0 - brush_size * 2, x1 - x0,
+                               brush_size * 2};
             SDL_RenderFillRect(renderer, &rect);
-            rect = (SDL_FRect){x0, y1, x1 - x0, state.brush_size * 2};
+            rect = (SDL_FRect){x0, y1, x1 - x0, brush_size * 2};
             SDL_RenderFillRect(renderer, &rect);
         }
 
-        rect = (SDL_FRect){x0 - state.brush_size * 2, y0, state.brush_size * 2,
-                           y1 - y0};
+        rect = (SDL_FRect){x0 - brush_size * 2, y0, brush_size * 2, y1 - y0};
         SDL_RenderFillRect(renderer, &rect);
-        rect = (SDL_FRect){x1, y0, state.brush_size * 2, y1 - y0};
+        rect = (SDL_FRect){x1, y0, brush_size * 2, y1 - y0};
         SDL_RenderFillRect(renderer, &rect);
     }
 }
 
-void tool_brush(SDL_Renderer *renderer, float x, float y, float xrel,
-                float yrel) {
+void draw_brush(SDL_Renderer *renderer, float x0, float y0, float x1, float y1,
+                float brush_size) {
+    float xrel = x1 - x0;
+    float yrel = y1 - y0;
+    float dist_sqared = (xrel * xrel) + (yrel * yrel);
+    if (dist_sqared >= brush_size * brush_size)
+        draw_line(renderer, x0, y0, x1, y1, brush_size, true);
+
+    render_filled_circle(renderer, x1, y1, brush_size);
+}
+
+// flood fills the pixels connected to (x, y) that share its color, filled
+// receives the bounding box of everything that was painted and coverage, if
+// given, a bitmask over that box of the painted pixels
+bool flood_fill(SDL_Surface *surface, int x, int y, SDL_Color color,
+                SDL_Rect *filled, Uint8 **coverage) {
+    static const int offsets[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    Uint32 *pixels = surface->pixels;
+    int stride = surface->pitch / sizeof(Uint32);
+    Uint32 fill_color = SDL_MapSurfaceRGBA(surface, color.r, color.g, color.b,
+                                           SDL_ALPHA_OPAQUE);
+    Uint32 source_color = pixels[(y * stride) + x];
+    if (source_color == fill_color)
+        return false;
+
+    int *queue = (int *)malloc(sizeof(int) * surface->w * surface->h);
+    if (queue == NULL)
+        return false;
+
+    int xmin = x, xmax = x, ymin = y, ymax = y;
+    int head = 0;
+    int tail = 0;
+    queue[tail++] = (surface->w * y) + x;
+    pixels[(y * stride) + x] = fill_color;
+
+    while (head < tail) {
+        int i = queue[head] % surface->w; // x coord
+        int j = queue[head] / surface->w; // y coord
+        head++;
+
+        xmin = SDL_min(xmin, i);
+        xmax = SDL_max(xmax, i);
+        ymin = SDL_min(ymin, j);
+        ymax = SDL_max(ymax, j);
+
+        for (int k = 0; k < 4; k++) {
+            int ni = i + offsets[k][0];
+            int nj = j + offsets[k][1];
+            if (ni < 0 || nj < 0 || ni >= surface->w || nj >= surface->h)
+                continue;
+            if (pixels[(nj * stride) + ni] != source_color)
+                continue;
+            pixels[(nj * stride) + ni] = fill_color;
+            queue[tail++] = (surface->w * nj) + ni;
+        }
+    }
+
+    // the queue still holds every painted pixel
+    int w = xmax - xmin + 1;
+    int h = ymax - ymin + 1;
+    if (coverage != NULL) {
+        *coverage = (Uint8 *)calloc((w * h + 7) / 8, 1);
+        for (int k = 0; *coverage != NULL && k < tail; k++) {
+            int bit = ((queue[k] / surface->w - ymin) * w) +
+                      (queue[k] % surface->w - xmin);
+            (*coverage)[bit / 8] |= 1 << (bit % 8);
+        }
+    }
+    free(queue);
+
+    if (filled != NULL)
+        *filled = (SDL_Rect){xmin, ymin, w, h};
+    return true;
+}
+
+// flood fill on the canvas texture, only pixels inside region are read back
+bool fill_canvas_region(SDL_Renderer *renderer, const SDL_Rect *region, int x,
+                        int y, SDL_Color color, SDL_Rect *filled,
+                        Uint8 **coverage) {
+    SDL_Point seed = {x, y};
+    if (!SDL_PointInRect(&seed, region))
+        return false;
+
     SDL_SetRenderTarget(renderer, canvas_texture);
-    if (state.tool == ERASER)
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
-    else
-        SDL_SetRenderDrawColor(renderer, state.color.r, state.color.g,
-                               state.color.b, SDL_ALPHA_OPAQUE);
+    SDL_Surface *surface = SDL_RenderReadPixels(renderer, region);
+    if (surface == NULL) {
+        SDL_Log("%s", SDL_GetError());
+        return false;
+    }
+    if (surface->format != SDL_PIXELFORMAT_ABGR8888) {
+        SDL_Surface *converted =
+            SDL_ConvertSurface(surface, SDL_PIXELFORMAT_ABGR8888);
+        SDL_DestroySurface(surface);
+        if (converted == NULL) {
+            SDL_Log("%s", SDL_GetError());
+            return false;
+        }
+        surface = converted;
+    }
 
-    float dist_sqared = (xrel * xrel) + (yrel * yrel);
-    if (dist_sqared >= state.brush_size * state.brush_size) {
-        SDL_SetRenderDrawColor(renderer, state.color.r, state.color.g,
-                               state.color.b, SDL_ALPHA_OPAQUE);
-        tool_line(renderer, canvas_texture, state.xprev, state.yprev, x, y,
-                  true);
+    SDL_Rect painted;
+    bool changed =
+        flood_fill(surface, x - region->x, y - region->y, color, &painted,
+                   coverage);
+    if (changed) {
+        SDL_UpdateTexture(canvas_texture, region, surface->pixels,
+                          surface->pitch);
+        if (filled != NULL)
+            *filled = (SDL_Rect){painted.x + region->x, painted.y + region->y,
+                                 painted.w, painted.h};
     }
+    SDL_DestroySurface(surface);
+    return changed;
+}
 
-    render_filled_circle(renderer, x, y, state.brush_size);
-};
+void tool_line(SDL_Renderer *renderer, SDL_Texture *texture, float x0, float y0,
+               float x1, float y1, bool circle_shape) {
+    SDL_Color color = tool_color();
+    SDL_SetRenderTarget(renderer, texture);
+    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b,
+                           SDL_ALPHA_OPAQUE);
+    draw_line(renderer, x0, y0, x1, y1, canvas_brush_size(), circle_shape);
+}
+
+void tool_box(SDL_Renderer *renderer, SDL_Texture *texture, float x0, float y0,
+              float x1, float y1) {
+    SDL_SetRenderTarget(renderer, texture);
+    SDL_SetRenderDrawColor(renderer, state.color.r, state.color.g,
+                           state.color.b, SDL_ALPHA_OPAQUE);
+    draw_box(renderer, x0, y0, x1, y1, canvas_brush_size());
+}
 
-void tool_fill(SDL_Renderer *renderer, float x, float y) {
+void tool_brush(SDL_Renderer *renderer, float x0, float y0, float x1,
+                float y1) {
+    SDL_Color color = tool_color();
     SDL_SetRenderTarget(renderer, canvas_texture);
-    SDL_Rect rect = {canvas_rect.x, canvas_rect.y, canvas_rect.w,
-                     canvas_rect.h};
-    SDL_Surface *surface = SDL_RenderReadPixels(renderer, NULL);
-    if (surface == NULL)
-        return;
+    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b,
+                           SDL_ALPHA_OPAQUE);
+    draw_brush(renderer, x0, y0, x1, y1, canvas_brush_size());
+}
+
+static inline SDL_Rect canvas_region() {
+    return (SDL_Rect){canvas_rect.x, canvas_rect.y, canvas_rect.w,
+                      canvas_rect.h};
+}
+
+bool tool_fill(SDL_Renderer *renderer, float x, float y, SDL_Rect *filled,
+               Uint8 **coverage) {
+    SDL_Rect region = canvas_region();
+    return fill_canvas_region(renderer, &region, x, y, state.color, filled,
+                              coverage);
+}
 
-    Uint8 r, g, b, a;
-    int i, j;
+int compare_primitive_order(const void *a, const void *b) {
+    const Primitive *pa = *(void *const *)a;
+    const Primitive *pb = *(void *const *)b;
+    return (pa->id > pb->id) - (pa->id < pb->id);
+}
+
+Primitive *new_primitive(tool tool, SDL_Color color, float brush_size) {
+    Primitive *primitive = (Primitive *)calloc(1, sizeof(Primitive));
+    primitive->tool = tool;
+    primitive->color = color;
+    primitive->brush_size = brush_size;
+    primitive->id = document.next_id++;
+    return primitive;
+}
+
+void free_primitive(Primitive *primitive) {
+    free(primitive->points);
+    free(primitive->coverage);
+    if (primitive->coverage_texture != NULL)
+        SDL_DestroyTexture(primitive->coverage_texture);
+    free(primitive);
+}
 
-    if (!SDL_ReadSurfacePixel(surface, x, y, &r, &g, &b, &a)) {
-        SDL_Log(SDL_GetError());
+void free_primitive_item(void *item) { free_primitive((Primitive *)item); }
+
+void primitive_add_point(Primitive *primitive, float x, float y) {
+    if (primitive->point_count == primitive->point_capacity) {
+        primitive->point_capacity =
+            primitive->point_capacity ? primitive->point_capacity * 2 : 16;
+        primitive->points = (SDL_FPoint *)realloc(
+            primitive->points, sizeof(SDL_FPoint) * primitive->point_capacity);
+    }
+    primitive->points[primitive->point_count++] = (SDL_FPoint){x, y};
+}
+
+// fills keep the bounds measured when they were flooded
+void primitive_update_bounds(Primitive *primitive) {
+    if (primitive->tool == FILL || primitive->point_count == 0)
         return;
+
+    float xmin = primitive->points[0].x, xmax = xmin;
+    float ymin = primitive->points[0].y, ymax = ymin;
+    for (int i = 1; i < primitive->point_count; i++) {
+        xmin = SDL_min(xmin, primitive->points[i].x);
+        xmax = SDL_max(xmax, primitive->points[i].x);
+        ymin = SDL_min(ymin, primitive->points[i].y);
+        ymax = SDL_max(ymax, primitive->points[i].y);
     }
 
-    Uint32 *pixels = surface->pixels;
-    Uint32 source_color = b | (g << 8) | (r << 16) | (a << 24);
+    float size = primitive->brush_size;
+    switch (primitive->tool) {
+    case LINE:
+        xmax += size * 2;
+        ymax += size * 2;
+        break;
+    case BOX:
+        xmin -= size * 2;
+        ymin -= size * 2;
+        xmax += size * 2;
+        ymax += size * 2;
+        break;
+    default:
+        xmin -= size;
+        ymin -= size;
+        xmax += size;
+        ymax += size;
+        break;
+    }
+    primitive->bounds = (SDL_FRect){xmin, ymin, xmax - xmin, ymax - ymin};
+}
 
-    int *queue = (int *)malloc(sizeof(int) * (canvas_rect.w * canvas_rect.h));
-    memset(queue, -1, canvas_rect.w * canvas_rect.h * sizeof(int));
-    queue[0] = (canvas_rect.w * y) + x;
+SDL_FPoint canvas_to_document(float x, float y) {
+    return (SDL_FPoint){
+        document.pan.x + (x - canvas_rect.x) / document.scale,
+        document.pan.y + (y - canvas_rect.y) / document.scale};
+}
 
-    int index = 0;
-    int counter = 1;
-    while (1) {
-        if (queue[index] == -1)
-            break;
+SDL_FPoint document_to_canvas(SDL_FPoint point) {
+    return (SDL_FPoint){
+        canvas_rect.x + (point.x - document.pan.x) * document.scale,
+        canvas_rect.y + (point.y - document.pan.y) * document.scale};
+}
+
+SDL_Rect document_to_pixels(const SDL_FRect *rect, int padding) {
+    SDL_FPoint min = document_to_canvas((SDL_FPoint){rect->x, rect->y});
+    SDL_FPoint max = document_to_canvas(
+        (SDL_FPoint){rect->x + rect->w, rect->y + rect->h});
+    int x0 = SDL_floorf(min.x) - padding;
+    int y0 = SDL_floorf(min.y) - padding;
+    int x1 = SDL_ceilf(max.x) + padding;
+    int y1 = SDL_ceilf(max.y) + padding;
+    return (SDL_Rect){x0, y0, x1 - x0, y1 - y0};
+}
 
-        i = queue[index] % rect.w;       // x coord
-        j = (queue[index] - 1) / rect.w; // y coord
+SDL_FRect pixels_to_document(const SDL_Rect *rect) {
+    SDL_FPoint min = canvas_to_document(rect->x, rect->y);
+    SDL_FPoint max = canvas_to_document(rect->x + rect->w, rect->y + rect->h);
+    return (SDL_FRect){min.x, min.y, max.x - min.x, max.y - min.y};
+}
+
+void document_update_scale() {
+    document.scale = SDL_GetWindowPixelDensity(window) * document.zoom;
+}
 
-        SDL_WriteSurfacePixel(surface, i, j, state.color.r, state.color.g,
-                              state.color.b, 255);
-        if (i - 1 >= 0 && pixels[(j * rect.w) + (i - 1)] == source_color) {
-            queue[counter] = (rect.w * j) + (i - 1); // queue x-1
-            SDL_WriteSurfacePixel(surface, i - 1, j, state.color.r,
-                                  state.color.g, state.color.b, 255);
-            counter++;
+// turns a fill's coverage bitmask into a texture in the fill's color
+SDL_Texture *new_coverage_texture(Primitive *primitive) {
+    SDL_Surface *surface =
+        SDL_CreateSurface(primitive->coverage_w, primitive->coverage_h,
+                          SDL_PIXELFORMAT_ABGR8888);
+    if (surface == NULL) {
+        SDL_Log("%s", SDL_GetError());
+        return NULL;
+    }
+    Uint32 fill_color =
+        SDL_MapSurfaceRGBA(surface, primitive->color.r, primitive->color.g,
+                           primitive->color.b, SDL_ALPHA_OPAQUE);
+    for (int j = 0; j < primitive->coverage_h; j++) {
+        Uint32 *row = (Uint32 *)((Uint8 *)surface->pixels + j * surface->pitch);
+        for (int i = 0; i < primitive->coverage_w; i++) {
+            int bit = (j * primitive->coverage_w) + i;
+            row[i] = primitive->coverage[bit / 8] & (1 << (bit % 8))
+                         ? fill_color
+                         : 0;
         }
-        if (i + 1 < rect.w && pixels[(j * rect.w) + (i + 1)] == source_color) {
-            queue[counter] = (rect.w * j) + (i + 1); // queue x+1
-            SDL_WriteSurfacePixel(surface, i + 1, j, state.color.r,
-                                  state.color.g, state.color.b, 255);
-            counter++;
+    }
+
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_DestroySurface(surface);
+    if (texture == NULL) {
+        SDL_Log("%s", SDL_GetError());
+        return NULL;
+    }
+    SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_NEAREST);
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    return texture;
+}
+
+// fills are replayed from the pixels they covered, not flooded again, so
+// they do not depend on their seed or on what else is visible
+void document_draw_fill(Primitive *primitive) {
+    if (primitive->coverage == NULL)
+        return;
+    if (primitive->coverage_texture == NULL)
+        primitive->coverage_texture = new_coverage_texture(primitive);
+    if (primitive->coverage_texture == NULL)
+        return;
+
+    SDL_FRect *bounds = &primitive->bounds;
+    SDL_FPoint min = document_to_canvas((SDL_FPoint){bounds->x, bounds->y});
+    SDL_FPoint max = document_to_canvas(
+        (SDL_FPoint){bounds->x + bounds->w, bounds->y + bounds->h});
+    SDL_FRect dst = {min.x, min.y, max.x - min.x, max.y - min.y};
+    SDL_RenderTexture(renderer, primitive->coverage_texture, NULL, &dst);
+}
+
+void document_draw_primitive(Primitive *primitive) {
+    float size = primitive->brush_size * document.scale;
+    SDL_FPoint *points = primitive->points;
+    SDL_FPoint a, b;
+
+    SDL_SetRenderDrawColor(renderer, primitive->color.r, primitive->color.g,
+                           primitive->color.b, SDL_ALPHA_OPAQUE);
+    switch (primitive->tool) {
+    case BRUSH:
+    case ERASER:
+        for (int i = 0; i < primitive->point_count; i++) {
+            a = document_to_canvas(points[i > 0 ? i - 1 : 0]);
+            b = document_to_canvas(points[i]);
+            draw_brush(renderer, a.x, a.y, b.x, b.y, size);
         }
-        if (j - 1 > rect.y && pixels[((j - 1) * rect.w) + i] == source_color) {
-            queue[counter] = (rect.w * (j - 1)) + (i); // queue y+1
-            SDL_WriteSurfacePixel(surface, i, j - 1, state.color.r,
-                                  state.color.g, state.color.b, 255);
-            counter++;
+        break;
+    case LINE:
+        a = document_to_canvas(points[0]);
+        b = document_to_canvas(points[1]);
+        draw_line(renderer, a.x, a.y, b.x, b.y, size, false);
+        break;
+    case BOX:
+        a = document_to_canvas(points[0]);
+        b = document_to_canvas(points[1]);
+        draw_box(renderer, a.x, a.y, b.x, b.y, size);
+        break;
+    case FILL:
+        document_draw_fill(primitive);
+        break;
+    default:
+        break;
+    }
+}
+
+// re-rasterize only the primitives whose bounds intersect damage
+void document_rasterize(SDL_FRect damage) {
+    SDL_Rect canvas = canvas_region();
+    SDL_Rect pixels = document_to_pixels(&damage, DAMAGE_PADDING);
+    SDL_Rect clip;
+    if (!SDL_GetRectIntersection(&pixels, &canvas, &clip))
+        return;
+
+    SDL_Rect padded = {clip.x - DAMAGE_PADDING, clip.y - DAMAGE_PADDING,
+                       clip.w + DAMAGE_PADDING * 2,
+                       clip.h + DAMAGE_PADDING * 2};
+    SDL_FRect query = pixels_to_document(&padded);
+    RTreeResults hits = {0};
+    rtree_search(document.root, &query, &hits);
+    qsort(hits.items, hits.count, sizeof(void *), compare_primitive_order);
+
+    SDL_SetRenderTarget(renderer, canvas_texture);
+    SDL_SetRenderClipRect(renderer, &clip);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
+    SDL_FRect background = {clip.x, clip.y, clip.w, clip.h};
+    SDL_RenderFillRect(renderer, &background);
+
+    for (int i = 0; i < hits.count; i++)
+        document_draw_primitive((Primitive *)hits.items[i]);
+    if (document.active != NULL &&
+        rect_overlaps(&document.active->bounds, &query))
+        document_draw_primitive(document.active);
+
+    SDL_SetRenderClipRect(renderer, NULL);
+    free(hits.items);
+}
+
+void document_rasterize_all() {
+    SDL_Rect canvas = canvas_region();
+    document_rasterize(pixels_to_document(&canvas));
+}
+
+void document_begin_stroke(float x, float y) {
+    SDL_FPoint point = canvas_to_document(x, y);
+    document.active = new_primitive(state.tool, tool_color(), state.brush_size);
+    primitive_add_point(document.active, point.x, point.y);
+    primitive_update_bounds(document.active);
+}
+
+void document_end_stroke() {
+    if (document.active == NULL)
+        return;
+    rtree_insert(&document.root, document.active, document.active->bounds);
+    document.active = NULL;
+}
+
+void document_extend_stroke(float x0, float y0, float x1, float y1) {
+    Primitive *stroke = document.active;
+    SDL_FPoint from = canvas_to_document(x0, y0);
+    SDL_FPoint to = canvas_to_document(x1, y1);
+
+    // the pointer left the canvas mid stroke, continue as a new stroke
+    if (stroke == NULL || stroke->points[stroke->point_count - 1].x != from.x ||
+        stroke->points[stroke->point_count - 1].y != from.y) {
+        document_end_stroke();
+        document_begin_stroke(x0, y0);
+        if (from.x == to.x && from.y == to.y)
+            return;
+    }
+    primitive_add_point(document.active, to.x, to.y);
+    primitive_update_bounds(document.active);
+}
+
+void document_add_shape(tool tool, float x0, float y0, float x1, float y1) {
+    if (tool == BOX && x0 == x1 && y0 == y1)
+        return;
+    SDL_FPoint from = canvas_to_document(x0, y0);
+    SDL_FPoint to = canvas_to_document(x1, y1);
+    Primitive *primitive = new_primitive(tool, tool_color(), state.brush_size);
+    primitive_add_point(primitive, from.x, from.y);
+    primitive_add_point(primitive, to.x, to.y);
+    primitive_update_bounds(primitive);
+    rtree_insert(&document.root, primitive, primitive->bounds);
+}
+
+void document_add_fill(float x, float y, const SDL_Rect *filled,
+                       Uint8 *coverage) {
+    SDL_FPoint seed = canvas_to_document((int)x, (int)y);
+    Primitive *primitive = new_primitive(FILL, state.color, 0);
+    primitive_add_point(primitive, seed.x, seed.y);
+    primitive->bounds = pixels_to_document(filled);
+    primitive->coverage = coverage;
+    primitive->coverage_w = filled->w;
+    primitive->coverage_h = filled->h;
+    rtree_insert(&document.root, primitive, primitive->bounds);
+}
+
+float segment_distance(SDL_FPoint p, SDL_FPoint a, SDL_FPoint b) {
+    float dx = b.x - a.x;
+    float dy = b.y - a.y;
+    float length_squared = dx * dx + dy * dy;
+    float t = 0;
+    if (length_squared > 0)
+        t = SDL_clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / length_squared,
+                      0.0f, 1.0f);
+    float ex = a.x + t * dx - p.x;
+    float ey = a.y + t * dy - p.y;
+    return SDL_sqrtf(ex * ex + ey * ey);
+}
+
+bool primitive_hit(Primitive *primitive, SDL_FPoint point) {
+    float size = primitive->brush_size;
+    float tolerance = size + 1 / document.scale;
+    SDL_FPoint *points = primitive->points;
+    SDL_FRect inner;
+
+    switch (primitive->tool) {
+    case BRUSH:
+    case ERASER:
+        for (int i = 0; i < primitive->point_count; i++) {
+            if (segment_distance(point, points[i > 0 ? i - 1 : 0], points[i]) <=
+                tolerance)
+                return true;
         }
-        if (j + 1 < rect.h + rect.y &&
-            pixels[((j + 1) * rect.w) + i] == source_color) {
-            queue[counter] = (rect.w * (j + 1)) + (i); // queue y-1
-            SDL_WriteSurfacePixel(surface, i, j + 1, state.color.r,
-                                  state.color.g, state.color.b, 255);
-            counter++;
+        return false;
+    case LINE: {
+        // line stamps are squares anchored at their top left corner
+        SDL_FPoint a = {points[0].x + size, points[0].y + size};
+        SDL_FPoint b = {points[1].x + size, points[1].y + size};
+        return segment_distance(point, a, b) <= tolerance;
+    }
+    case BOX:
+        inner = primitive->bounds;
+        inner.x += size * 4 + tolerance;
+        inner.y += size * 4 + tolerance;
+        inner.w -= (size * 4 + tolerance) * 2;
+        inner.h -= (size * 4 + tolerance) * 2;
+        return inner.w <= 0 || inner.h <= 0 ||
+               point.x < inner.x || point.y < inner.y ||
+               point.x > inner.x + inner.w || point.y > inner.y + inner.h;
+    case FILL: {
+        if (primitive->coverage == NULL)
+            return false;
+        int i = SDL_floorf((point.x - primitive->bounds.x) /
+                           primitive->bounds.w * primitive->coverage_w);
+        int j = SDL_floorf((point.y - primitive->bounds.y) /
+                           primitive->bounds.h * primitive->coverage_h);
+        if (i < 0 || j < 0 || i >= primitive->coverage_w ||
+            j >= primitive->coverage_h)
+            return false;
+        int bit = (j * primitive->coverage_w) + i;
+        return primitive->coverage[bit / 8] & (1 << (bit % 8));
+    }
+    default:
+        return false;
+    }
+}
+
+// delete the topmost primitive under (x, y) and repaint what it covered
+void document_delete_at(float x, float y) {
+    SDL_FPoint point = canvas_to_document(x, y);
+    SDL_FRect rect = {point.x, point.y, 0, 0};
+    RTreeResults hits = {0};
+    Primitive *target = NULL;
+
+    rtree_search(document.root, &rect, &hits);
+    qsort(hits.items, hits.count, sizeof(void *),
+          compare_primitive_order);
+    for (int i = hits.count - 1; i >= 0; i--) {
+        if (primitive_hit((Primitive *)hits.items[i], point)) {
+            target = (Primitive *)hits.items[i];
+            break;
         }
-        index++;
     }
-    free(queue);
-    SDL_UpdateTexture(canvas_texture, NULL, surface->pixels, surface->pitch);
-    SDL_DestroySurface(surface);
+    free(hits.items);
+    if (target == NULL)
+        return;
+
+    SDL_FRect damage = target->bounds;
+    rtree_remove(&document.root, target, target->bounds);
+    free_primitive(target);
+    document_rasterize(damage);
+}
+
+// zoom about the middle of the visible canvas
+void document_set_zoom(float zoom) {
+    zoom = SDL_clamp(zoom, DOCUMENT_MIN_ZOOM, DOCUMENT_MAX_ZOOM);
+    if (zoom == document.zoom)
+        return;
+    SDL_FPoint center = canvas_to_document(canvas_rect.x + canvas_rect.w / 2,
+                                           canvas_rect.y + canvas_rect.h / 2);
+    document.zoom = zoom;
+    document_update_scale();
+    document.pan.x = center.x - canvas_rect.w / 2 / document.scale;
+    document.pan.y = center.y - canvas_rect.h / 2 / document.scale;
+    cancel_drag();
+    document_rasterize_all();
+}
+
+// dx and dy are fractions of the visible canvas
+void document_pan(float dx, float dy) {
+    document.pan.x += dx * canvas_rect.w / document.scale;
+    document.pan.y += dy * canvas_rect.h / document.scale;
+    cancel_drag();
+    document_rasterize_all();
+}
+
+void free_document() {
+    if (document.active != NULL)
+        free_primitive(document.active);
+    document.active = NULL;
+    rtree_free(document.root, free_primitive_item);
+    document.root = NULL;
 }
 
 void canvas_handle_click(SDL_Event *event) {
@@ -381,7 +895,9 @@ void canvas_handle_click(SDL_Event *event) {
     case BRUSH:
     case ERASER:
         tool_brush(renderer, event->button.x, event->button.y,
-                   event->motion.xrel, event->motion.yrel);
+                   event->button.x, event->button.y);
+        if (state.vector_mode)
+            document_begin_stroke(event->button.x, event->button.y);
         break;
     case LINE:
         state.xstart = event->button.x;
@@ -395,8 +911,16 @@ void canvas_handle_click(SDL_Event *event) {
         SDL_Log("box start %f, %f", event->button.x, event->button.y);
         state.drag_in_progress = true;
         break;
-    case FILL:
-        tool_fill(renderer, event->button.x, event->button.y);
+    case FILL: {
+        SDL_Rect filled;
+        Uint8 *coverage = NULL;
+        if (tool_fill(renderer, event->button.x, event->button.y, &filled,
+                      state.vector_mode ? &coverage : NULL) &&
+            state.vector_mode)
+            document_add_fill(event->button.x, event->button.y, &filled,
+                              coverage);
+        break;
+    }
     default:
         break;
     }
@@ -405,12 +929,13 @@ void canvas_handle_click(SDL_Event *event) {
 void toolbar_handle_click(SDL_Event *event) {
     ButtonNode *curr = state.buttons;
     while (curr != NULL) {
-        if (SDL_PointInRectFloat(new_point(event->button.x, event->button.y),
+        if (SDL_PointInRectFloat(new_point(event->button.x / toolbar_scale,
+                                           event->button.y / toolbar_scale),
                                  &curr->button.rect)) {
             switch (curr->button.type) {
             case TOOL:
                 if (state.tool != curr->button.tool) {
-                    SDL_SetRenderTarget(renderer, toolbar_texture);
+                    set_toolbar_target();
                     ButtonNode *curr1 = state.buttons;
                     while (curr1 != NULL) {
                         if (curr1->button.tool == state.tool) {
@@ -427,7 +952,7 @@ void toolbar_handle_click(SDL_Event *event) {
                 break;
             case SIZE:
                 if (state.brush_size != curr->button.brush_size) {
-                    SDL_SetRenderTarget(renderer, toolbar_texture);
+                    set_toolbar_target();
                     ButtonNode *curr1 = state.buttons;
                     while (curr1 != NULL) {
                         if (curr1->button.brush_size == state.brush_size) {
@@ -444,7 +969,7 @@ void toolbar_handle_click(SDL_Event *event) {
                 break;
             case PALETTE:
                 state.color = curr->button.color;
-                SDL_SetRenderTarget(renderer, toolbar_texture);
+                set_toolbar_target();
                 SDL_SetRenderDrawColor(renderer, state.color.r, state.color.g,
                                        state.color.b, SDL_ALPHA_OPAQUE);
                 SDL_RenderFillRect(renderer, &current_color_rect);
@@ -457,10 +982,128 @@ void toolbar_handle_click(SDL_Event *event) {
         }
         curr = curr->next;
     }
+    SDL_SetRenderScale(renderer, 1, 1);
+}
+
+SDL_Texture *new_canvas_texture(int w, int h, Uint8 alpha) {
+    SDL_Texture *texture = SDL_CreateTexture(
+        renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_TARGET, w, h);
+    if (!texture) {
+        SDL_Log("Couldn't create texture: %s", SDL_GetError());
+        return NULL;
+    }
+    SDL_SetRenderTarget(renderer, texture);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, alpha);
+    SDL_RenderClear(renderer);
+    return texture;
+}
+
+// (re)create the canvas at the output size in pixels, raster mode keeps the
+// old pixels, vector mode is re-rasterized by the caller
+bool create_canvas_textures(int w, int h) {
+    SDL_Texture *texture = new_canvas_texture(w, h, SDL_ALPHA_OPAQUE);
+    SDL_Texture *preview = new_canvas_texture(w, h, SDL_ALPHA_TRANSPARENT);
+    if (!texture || !preview) {
+        SDL_DestroyTexture(texture);
+        SDL_DestroyTexture(preview);
+        return false;
+    }
+
+    // the old drawing moves below the new toolbar, scaled to the new density
+    float density = SDL_GetWindowPixelDensity(window);
+    SDL_FRect new_rect = {0, toolbar_rect.h, w, h - toolbar_rect.h};
+    if (canvas_texture != NULL && !state.vector_mode) {
+        float ratio = density / canvas_density;
+        SDL_FRect moved_rect = {new_rect.x, new_rect.y, canvas_rect.w * ratio,
+                                canvas_rect.h * ratio};
+        SDL_SetRenderTarget(renderer, texture);
+        SDL_RenderTexture(renderer, canvas_texture, &canvas_rect, &moved_rect);
+    }
+    SDL_DestroyTexture(canvas_texture);
+    SDL_DestroyTexture(canvas_texture_preview);
+    canvas_texture = texture;
+    canvas_texture_preview = preview;
+
+    canvas_rect = new_rect;
+    canvas_density = density;
+    return true;
+}
+
+// the toolbar is laid out in window coordinates and drawn scaled by the
+// pixel density, so it keeps its size on HiDPI displays
+bool create_toolbar(int w) {
+    float density = SDL_GetWindowPixelDensity(window);
+    int h = SDL_ceilf(TOOLBAR_HEIGHT * density);
+    SDL_Texture *texture = SDL_CreateTexture(
+        renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_TARGET, w, h);
+    if (!texture) {
+        SDL_Log("Couldn't create texture: %s", SDL_GetError());
+        return false;
+    }
+    SDL_DestroyTexture(toolbar_texture);
+    toolbar_texture = texture;
+    toolbar_scale = density;
+    toolbar_rect = (SDL_FRect){0, 0, w, h};
+
+    free_buttons();
+    state.buttons = NULL;
+    toolbar_button_offset = TOOLBAR_MARGIN;
+    set_toolbar_target();
+    SDL_SetRenderDrawColor(renderer, 200, 200, 200, SDL_ALPHA_OPAQUE);
+    SDL_RenderClear(renderer);
+
+    new_tool_button(renderer, BRUSH, "brush");
+    new_tool_button(renderer, ERASER, "erase");
+    new_tool_button(renderer, LINE, "line");
+    new_tool_button(renderer, BOX, "box");
+    new_tool_button(renderer, FILL, "fill");
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
+    SDL_RenderLine(renderer, toolbar_button_offset, 0, toolbar_button_offset,
+                   TOOLBAR_HEIGHT);
+    toolbar_button_offset += TOOLBAR_MARGIN;
+
+    new_brush_size_button(renderer, 0.5);
+    new_brush_size_button(renderer, 1);
+    new_brush_size_button(renderer, 2);
+    new_brush_size_button(renderer, 4);
+    new_brush_size_button(renderer, 8);
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
+    SDL_RenderLine(renderer, toolbar_button_offset, 0, toolbar_button_offset,
+                   TOOLBAR_HEIGHT);
+    toolbar_button_offset += TOOLBAR_MARGIN;
+
+    SDL_SetRenderDrawColor(renderer, 150, 150, 150, SDL_ALPHA_OPAQUE);
+    current_color_rect = (SDL_FRect){toolbar_button_offset + TOOLBAR_MARGIN,
+                                     (TOOLBAR_HEIGHT / 4), TOOLBAR_HEIGHT / 2,
+                                     TOOLBAR_HEIGHT / 2};
+    struct SDL_FRect palette_bg = {
+        toolbar_button_offset, TOOLBAR_MARGIN,
+        (TOOLBAR_HEIGHT / 4) * 10 + (3 * TOOLBAR_MARGIN) + current_color_rect.w,
+        TOOLBAR_HEIGHT - (2 * TOOLBAR_MARGIN)};
+    SDL_RenderFillRect(renderer, &palette_bg);
+    toolbar_button_offset += TOOLBAR_MARGIN;
+
+    SDL_SetRenderDrawColor(renderer, state.color.r, state.color.g,
+                           state.color.b, SDL_ALPHA_OPAQUE);
+    SDL_RenderFillRect(renderer, &current_color_rect);
+    toolbar_button_offset += current_color_rect.w;
+    toolbar_button_offset += TOOLBAR_MARGIN;
+    for (size_t i = 0; i < 20; i++) {
+        new_palette_button(renderer, color_from_string(palette_colors[i]),
+                           i % 2);
+    }
+
+    SDL_SetRenderScale(renderer, 1, 1);
+    return true;
 }
 
 // input events
 SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
+    // the canvas textures are sized in pixels, not window coordinates
+    SDL_ConvertEventToRenderCoordinates(renderer, event);
+
     switch (event->type) {
     case SDL_EVENT_QUIT:
         return SDL_APP_SUCCESS;
@@ -471,18 +1114,54 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
         case SDL_SCANCODE_ESCAPE:
         case SDL_SCANCODE_Q:
             return SDL_APP_SUCCESS;
+        case SDL_SCANCODE_EQUALS:
+            if (state.vector_mode)
+                document_set_zoom(document.zoom * 2);
+            break;
+        case SDL_SCANCODE_MINUS:
+            if (state.vector_mode)
+                document_set_zoom(document.zoom / 2);
+            break;
+        case SDL_SCANCODE_LEFT:
+            if (state.vector_mode)
+                document_pan(-DOCUMENT_PAN_STEP, 0);
+            break;
+        case SDL_SCANCODE_RIGHT:
+            if (state.vector_mode)
+                document_pan(DOCUMENT_PAN_STEP, 0);
+            break;
+        case SDL_SCANCODE_UP:
+            if (state.vector_mode)
+                document_pan(0, -DOCUMENT_PAN_STEP);
+            break;
+        case SDL_SCANCODE_DOWN:
+            if (state.vector_mode)
+                document_pan(0, DOCUMENT_PAN_STEP);
+            break;
         default:
             break;
         }
         break;
+    case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+        if (!create_toolbar(event->window.data1) ||
+            !create_canvas_textures(event->window.data1, event->window.data2))
+            return SDL_APP_FAILURE;
+        cancel_drag();
+        document_update_scale();
+        if (state.vector_mode)
+            document_rasterize_all();
+        break;
     case SDL_EVENT_MOUSE_BUTTON_DOWN:
         if (event->button.button == SDL_BUTTON_LEFT) {
-            state.mouse_on_canvas = event->button.y > TOOLBAR_HEIGHT;
+            state.mouse_on_canvas = event->button.y > toolbar_rect.h;
             if (state.mouse_on_canvas) {
                 canvas_handle_click(event);
             } else {
                 toolbar_handle_click(event);
             }
+        } else if (event->button.button == SDL_BUTTON_RIGHT &&
+                   state.vector_mode && event->button.y > toolbar_rect.h) {
+            document_delete_at(event->button.x, event->button.y);
         }
         break;
     case SDL_EVENT_MOUSE_BUTTON_UP:
@@ -494,6 +1173,9 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
                     tool_line(renderer, canvas_texture, state.xstart,
                               state.ystart, event->button.x, event->button.y,
                               false);
+                    if (state.vector_mode)
+                        document_add_shape(LINE, state.xstart, state.ystart,
+                                           event->button.x, event->button.y);
                     SDL_Log("line end %f, %f", event->button.x,
                             event->button.y);
                 }
@@ -503,6 +1185,9 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
                     clear_canvas_preview();
                     tool_box(renderer, canvas_texture, state.xstart,
                              state.ystart, event->button.x, event->button.y);
+                    if (state.vector_mode)
+                        document_add_shape(BOX, state.xstart, state.ystart,
+                                           event->button.x, event->button.y);
                     SDL_Log("box end %f, %f", event->button.x, event->button.y);
                 }
                 break;
@@ -510,15 +1195,25 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
                 break;
             }
             state.drag_in_progress = false;
+            document_end_stroke();
         }
         break;
     case SDL_EVENT_MOUSE_MOTION:
-        state.mouse_on_canvas = event->motion.y > TOOLBAR_HEIGHT;
+        state.mouse_on_canvas = event->motion.y > toolbar_rect.h;
         if (event->motion.state == SDL_BUTTON_LMASK) {
             if (state.mouse_on_canvas &&
                 (state.tool == BRUSH || state.tool == ERASER)) {
-                tool_brush(renderer, event->motion.x, event->motion.y,
-                           event->motion.xrel, event->motion.yrel);
+                // coming back from the toolbar, start at the first point on
+                // the canvas rather than where the pointer left it
+                if (!state.prev_motion_on_canvas) {
+                    state.xprev = event->motion.x;
+                    state.yprev = event->motion.y;
+                }
+                tool_brush(renderer, state.xprev, state.yprev, event->motion.x,
+                           event->motion.y);
+                if (state.vector_mode)
+                    document_extend_stroke(state.xprev, state.yprev,
+                                           event->motion.x, event->motion.y);
             } else if (state.drag_in_progress) {
                 // temp line progress
                 clear_canvas_preview();
@@ -533,9 +1228,11 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
             }
         } else {
             state.drag_in_progress = false;
+            document_end_stroke();
         }
         state.xprev = event->motion.x;
         state.yprev = event->motion.y;
+        state.prev_motion_on_canvas = state.mouse_on_canvas;
         break;
     default:
         break;
@@ -564,92 +1261,28 @@ SDL_AppResult SDL_AppIterate(void *appstate) {
 SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
     SDL_SetAppMetadata("Paint", "0.1", "com.shezdy.paint");
 
+    for (int i = 1; i < argc; i++) {
+        if (SDL_strcmp(argv[i], "--vector") == 0)
+            state.vector_mode = true;
+    }
+
     if (!SDL_Init(SDL_INIT_VIDEO)) {
         SDL_Log("Couldn't initialize SDL: %s", SDL_GetError());
         return SDL_APP_FAILURE;
     }
 
-    if (!SDL_CreateWindowAndRenderer("examples/renderer/clear", WINDOW_WIDTH,
-                                     WINDOW_HEIGHT, 0, &window, &renderer)) {
+    if (!SDL_CreateWindowAndRenderer(
+            "examples/renderer/clear", WINDOW_WIDTH, WINDOW_HEIGHT,
+            SDL_WINDOW_HIGH_PIXEL_DENSITY, &window, &renderer)) {
         SDL_Log("Couldn't create window/renderer: %s", SDL_GetError());
         return SDL_APP_FAILURE;
     }
 
     int w, h;
     SDL_GetRenderOutputSize(renderer, &w, &h);
-    canvas_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888,
-                                       SDL_TEXTUREACCESS_TARGET, w, h);
-    if (!canvas_texture) {
-        SDL_Log("Couldn't create texture: %s", SDL_GetError());
+    if (!create_toolbar(w) || !create_canvas_textures(w, h))
         return SDL_APP_FAILURE;
-    }
-    SDL_SetRenderTarget(renderer, canvas_texture);
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
-    SDL_RenderClear(renderer);
-
-    canvas_texture_preview = SDL_CreateTexture(
-        renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_TARGET, w, h);
-    if (!canvas_texture_preview) {
-        SDL_Log("Couldn't create texture: %s", SDL_GetError());
-        return SDL_APP_FAILURE;
-    }
-    SDL_SetRenderTarget(renderer, canvas_texture_preview);
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_TRANSPARENT);
-    SDL_RenderClear(renderer);
-
-    toolbar_texture =
-        SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888,
-                          SDL_TEXTUREACCESS_TARGET, w, TOOLBAR_HEIGHT);
-    if (!toolbar_texture) {
-        SDL_Log("Couldn't create texture: %s", SDL_GetError());
-        return SDL_APP_FAILURE;
-    }
-    SDL_SetRenderTarget(renderer, toolbar_texture);
-    SDL_SetRenderDrawColor(renderer, 200, 200, 200, SDL_ALPHA_OPAQUE);
-    SDL_RenderClear(renderer);
-
-    new_tool_button(renderer, BRUSH, "brush");
-    new_tool_button(renderer, ERASER, "erase");
-    new_tool_button(renderer, LINE, "line");
-    new_tool_button(renderer, BOX, "box");
-    new_tool_button(renderer, FILL, "fill");
-
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
-    SDL_RenderLine(renderer, toolbar_button_offset, 0, toolbar_button_offset,
-                   TOOLBAR_HEIGHT);
-    toolbar_button_offset += TOOLBAR_MARGIN;
-
-    new_brush_size_button(renderer, 0.5);
-    new_brush_size_button(renderer, 1);
-    new_brush_size_button(renderer, 2);
-    new_brush_size_button(renderer, 4);
-    new_brush_size_button(renderer, 8);
-
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
-    SDL_RenderLine(renderer, toolbar_button_offset, 0, toolbar_button_offset,
-                   TOOLBAR_HEIGHT);
-    toolbar_button_offset += TOOLBAR_MARGIN;
-
-    SDL_SetRenderDrawColor(renderer, 150, 150, 150, SDL_ALPHA_OPAQUE);
-    current_color_rect = (SDL_FRect){toolbar_button_offset + TOOLBAR_MARGIN,
-                                     (TOOLBAR_HEIGHT / 4), TOOLBAR_HEIGHT / 2,
-                                     TOOLBAR_HEIGHT / 2};
-    struct SDL_FRect palette_bg = {
-        toolbar_button_offset, TOOLBAR_MARGIN,
-        (TOOLBAR_HEIGHT / 4) * 10 + (3 * TOOLBAR_MARGIN) + current_color_rect.w,
-        TOOLBAR_HEIGHT - (2 * TOOLBAR_MARGIN)};
-    SDL_RenderFillRect(renderer, &palette_bg);
-    toolbar_button_offset += TOOLBAR_MARGIN;
-
-    SDL_SetRenderDrawColor(renderer, state.color.r, state.color.g,
-                           state.color.b, SDL_ALPHA_OPAQUE);
-    SDL_RenderFillRect(renderer, &current_color_rect);
-    toolbar_button_offset += current_color_rect.w;
-    toolbar_button_offset += TOOLBAR_MARGIN;
-    for (size_t i = 0; i < 20; i++) {
-        new_palette_button(renderer, color_from_string(palette_colors[i]),
-                           i % 2);
-    }
+    document_update_scale();
 
     SDL_SetRenderTarget(renderer, NULL);
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
@@ -663,4 +1296,5 @@ void SDL_AppQuit(void *appstate, SDL_AppResult result) {
     SDL_DestroyTexture(canvas_texture_preview);
     SDL_DestroyTexture(toolbar_texture);
     free_buttons();
+    free_document();
 }
\ No newline at end of file
@@ -0,0 +1,292 @@
+#include "rtree.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct EntryList {
+    RTreeEntry *entries;
+    int count;
+    int capacity;
+} EntryList;
+
+static inline float rect_area(const SDL_FRect *r) { return r->w * r->h; }
+
+static inline float rect_enlargement(const SDL_FRect *r,
+                                     const SDL_FRect *add) {
+    SDL_FRect u = rect_union(r, add);
+    return rect_area(&u) - rect_area(r);
+}
+
+void rtree_results_push(RTreeResults *results, void *item) {
+    if (results->count == results->capacity) {
+        results->capacity = results->capacity ? results->capacity * 2 : 32;
+        results->items = (void **)realloc(results->items,
+                                          sizeof(void *) * results->capacity);
+    }
+    results->items[results->count++] = item;
+}
+
+static void entry_list_push(EntryList *list, RTreeEntry entry) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 32;
+        list->entries = (RTreeEntry *)realloc(
+            list->entries, sizeof(RTreeEntry) * list->capacity);
+    }
+    list->entries[list->count++] = entry;
+}
+
+static RTreeNode *rtree_new_node(bool leaf) {
+    RTreeNode *node = (RTreeNode *)calloc(1, sizeof(RTreeNode));
+    node->leaf = leaf;
+    return node;
+}
+
+SDL_FRect rtree_node_bounds(RTreeNode *node) {
+    SDL_FRect bounds = node->entries[0].bounds;
+    for (int i = 1; i < node->count; i++)
+        bounds = rect_union(&bounds, &node->entries[i].bounds);
+    return bounds;
+}
+
+static void rtree_add_entry(RTreeNode *node, RTreeEntry entry) {
+    if (entry.child != NULL)
+        entry.child->parent = node;
+    node->entries[node->count++] = entry;
+}
+
+static void rtree_remove_entry(RTreeNode *node, int index) {
+    node->count--;
+    for (int i = index; i < node->count; i++)
+        node->entries[i] = node->entries[i + 1];
+}
+
+static int rtree_child_index(RTreeNode *node, RTreeNode *child) {
+    for (int i = 0; i < node->count; i++) {
+        if (node->entries[i].child == child)
+            return i;
+    }
+    return -1;
+}
+
+static RTreeNode *rtree_choose_leaf(RTreeNode *node, const SDL_FRect *bounds) {
+    while (!node->leaf) {
+        int best = 0;
+        float best_enlargement = 0;
+        float best_area = 0;
+        for (int i = 0; i < node->count; i++) {
+            float enlargement =
+                rect_enlargement(&node->entries[i].bounds, bounds);
+            float area = rect_area(&node->entries[i].bounds);
+            if (i == 0 || enlargement < best_enlargement ||
+                (enlargement == best_enlargement && area < best_area)) {
+                best = i;
+                best_enlargement = enlargement;
+                best_area = area;
+            }
+        }
+        node = node->entries[best].child;
+    }
+    return node;
+}
+
+// quadratic split, moves part of an overflowing node into a new sibling
+static RTreeNode *rtree_split(RTreeNode *node) {
+    RTreeEntry entries[RTREE_MAX_ENTRIES + 1];
+    bool assigned[RTREE_MAX_ENTRIES + 1] = {false};
+    int count = node->count;
+    memcpy(entries, node->entries, sizeof(RTreeEntry) * count);
+
+    int seed_a = 0, seed_b = 1;
+    float worst = -1;
+    for (int i = 0; i < count; i++) {
+        for (int j = i + 1; j < count; j++) {
+            SDL_FRect u = rect_union(&entries[i].bounds, &entries[j].bounds);
+            float waste = rect_area(&u) - rect_area(&entries[i].bounds) -
+                          rect_area(&entries[j].bounds);
+            if (waste > worst) {
+                worst = waste;
+                seed_a = i;
+                seed_b = j;
+            }
+        }
+    }
+
+    RTreeNode *sibling = rtree_new_node(node->leaf);
+    node->count = 0;
+    rtree_add_entry(node, entries[seed_a]);
+    rtree_add_entry(sibling, entries[seed_b]);
+    assigned[seed_a] = assigned[seed_b] = true;
+    SDL_FRect bounds_a = entries[seed_a].bounds;
+    SDL_FRect bounds_b = entries[seed_b].bounds;
+
+    for (int remaining = count - 2; remaining > 0; remaining--) {
+        RTreeNode *forced = NULL;
+        if (node->count + remaining == RTREE_MIN_ENTRIES)
+            forced = node;
+        else if (sibling->count + remaining == RTREE_MIN_ENTRIES)
+            forced = sibling;
+
+        int next = -1;
+        float next_a = 0, next_b = 0, best_diff = -1;
+        for (int i = 0; i < count; i++) {
+            if (assigned[i])
+                continue;
+            float da = rect_enlargement(&bounds_a, &entries[i].bounds);
+            float db = rect_enlargement(&bounds_b, &entries[i].bounds);
+            if (SDL_fabsf(da - db) > best_diff) {
+                best_diff = SDL_fabsf(da - db);
+                next = i;
+                next_a = da;
+                next_b = db;
+            }
+        }
+
+        bool to_a;
+        if (forced != NULL)
+            to_a = forced == node;
+        else if (next_a != next_b)
+            to_a = next_a < next_b;
+        else if (rect_area(&bounds_a) != rect_area(&bounds_b))
+            to_a = rect_area(&bounds_a) < rect_area(&bounds_b);
+        else
+            to_a = node->count <= sibling->count;
+
+        if (to_a) {
+            rtree_add_entry(node, entries[next]);
+            bounds_a = rect_union(&bounds_a, &entries[next].bounds);
+        } else {
+            rtree_add_entry(sibling, entries[next]);
+            bounds_b = rect_union(&bounds_b, &entries[next].bounds);
+        }
+        assigned[next] = true;
+    }
+    return sibling;
+}
+
+// propagate bounds (and a split, if any) from node up to the root
+static void rtree_adjust(RTreeNode **root, RTreeNode *node,
+                         RTreeNode *sibling) {
+    while (node->parent != NULL) {
+        RTreeNode *parent = node->parent;
+        parent->entries[rtree_child_index(parent, node)].bounds =
+            rtree_node_bounds(node);
+        if (sibling != NULL) {
+            rtree_add_entry(parent, (RTreeEntry){rtree_node_bounds(sibling),
+                                                 sibling, NULL});
+            sibling = parent->count > RTREE_MAX_ENTRIES ? rtree_split(parent)
+                                                        : NULL;
+        }
+        node = parent;
+    }
+
+    if (sibling != NULL) {
+        RTreeNode *new_root = rtree_new_node(false);
+        rtree_add_entry(new_root,
+                        (RTreeEntry){rtree_node_bounds(node), node, NULL});
+        rtree_add_entry(new_root, (RTreeEntry){rtree_node_bounds(sibling),
+                                               sibling, NULL});
+        *root = new_root;
+    }
+}
+
+void rtree_insert(RTreeNode **root, void *item, SDL_FRect bounds) {
+    if (*root == NULL)
+        *root = rtree_new_node(true);
+
+    RTreeNode *leaf = rtree_choose_leaf(*root, &bounds);
+    rtree_add_entry(leaf, (RTreeEntry){bounds, NULL, item});
+    RTreeNode *sibling =
+        leaf->count > RTREE_MAX_ENTRIES ? rtree_split(leaf) : NULL;
+    rtree_adjust(root, leaf, sibling);
+}
+
+static RTreeNode *rtree_find_leaf(RTreeNode *node, void *item,
+                                  const SDL_FRect *bounds, int *index) {
+    for (int i = 0; i < node->count; i++) {
+        if (node->leaf) {
+            if (node->entries[i].item == item) {
+                *index = i;
+                return node;
+            }
+        } else if (rect_overlaps(&node->entries[i].bounds, bounds)) {
+            RTreeNode *leaf =
+                rtree_find_leaf(node->entries[i].child, item, bounds, index);
+            if (leaf != NULL)
+                return leaf;
+        }
+    }
+    return NULL;
+}
+
+// frees the nodes of a subtree, collecting its leaf entries for reinsertion
+static void rtree_dissolve(RTreeNode *node, EntryList *orphans) {
+    for (int i = 0; i < node->count; i++) {
+        if (node->leaf)
+            entry_list_push(orphans, node->entries[i]);
+        else
+            rtree_dissolve(node->entries[i].child, orphans);
+    }
+    free(node);
+}
+
+void rtree_remove(RTreeNode **root, void *item, SDL_FRect bounds) {
+    int index;
+    RTreeNode *leaf =
+        *root != NULL ? rtree_find_leaf(*root, item, &bounds, &index) : NULL;
+    if (leaf == NULL)
+        return;
+    rtree_remove_entry(leaf, index);
+
+    EntryList orphans = {0};
+    RTreeNode *node = leaf;
+    while (node->parent != NULL) {
+        RTreeNode *parent = node->parent;
+        int i = rtree_child_index(parent, node);
+        if (node->count < RTREE_MIN_ENTRIES) {
+            rtree_remove_entry(parent, i);
+            rtree_dissolve(node, &orphans);
+        } else {
+            parent->entries[i].bounds = rtree_node_bounds(node);
+        }
+        node = parent;
+    }
+
+    while (!(*root)->leaf && (*root)->count <= 1) {
+        RTreeNode *child =
+            (*root)->count == 1 ? (*root)->entries[0].child : NULL;
+        free(*root);
+        *root = child;
+        if (child == NULL)
+            break;
+        child->parent = NULL;
+    }
+
+    for (int i = 0; i < orphans.count; i++)
+        rtree_insert(root, orphans.entries[i].item, orphans.entries[i].bounds);
+    free(orphans.entries);
+}
+
+void rtree_search(RTreeNode *node, const SDL_FRect *rect,
+                  RTreeResults *results) {
+    if (node == NULL)
+        return;
+    for (int i = 0; i < node->count; i++) {
+        if (!rect_overlaps(&node->entries[i].bounds, rect))
+            continue;
+        if (node->leaf)
+            rtree_results_push(results, node->entries[i].item);
+        else
+            rtree_search(node->entries[i].child, rect, results);
+    }
+}
+
+void rtree_free(RTreeNode *node, void (*free_item)(void *)) {
+    if (node == NULL)
+        return;
+    for (int i = 0; i < node->count; i++) {
+        if (!node->leaf)
+            rtree_free(node->entries[i].child, free_item);
+        else if (free_item != NULL)
+            free_item(node->entries[i].item);
+    }
+    free(node);
+}
@@ -0,0 +1,51 @@
+#ifndef RTREE_H
+#define RTREE_H
+
+#include <SDL3/SDL.h>
+
+#define RTREE_MAX_ENTRIES 8
+#define RTREE_MIN_ENTRIES 3
+
+// r-tree over bounding boxes (Guttman, quadratic split), items are opaque
+typedef struct RTreeEntry {
+    SDL_FRect bounds;
+    struct RTreeNode *child;
+    void *item;
+} RTreeEntry;
+
+typedef struct RTreeNode {
+    bool leaf;
+    int count;
+    struct RTreeNode *parent;
+    RTreeEntry entries[RTREE_MAX_ENTRIES + 1];
+} RTreeNode;
+
+typedef struct RTreeResults {
+    void **items;
+    int count;
+    int capacity;
+} RTreeResults;
+
+static inline bool rect_overlaps(const SDL_FRect *a, const SDL_FRect *b) {
+    return a->x <= b->x + b->w && b->x <= a->x + a->w &&
+           a->y <= b->y + b->h && b->y <= a->y + a->h;
+}
+
+static inline SDL_FRect rect_union(const SDL_FRect *a, const SDL_FRect *b) {
+    float x0 = SDL_min(a->x, b->x);
+    float y0 = SDL_min(a->y, b->y);
+    float x1 = SDL_max(a->x + a->w, b->x + b->w);
+    float y1 = SDL_max(a->y + a->h, b->y + b->h);
+    return (SDL_FRect){x0, y0, x1 - x0, y1 - y0};
+}
+
+SDL_FRect rtree_node_bounds(RTreeNode *node);
+void rtree_insert(RTreeNode **root, void *item, SDL_FRect bounds);
+// bounds must be the ones the item was inserted with
+void rtree_remove(RTreeNode **root, void *item, SDL_FRect bounds);
+void rtree_search(RTreeNode *node, const SDL_FRect *rect,
+                  RTreeResults *results);
+void rtree_free(RTreeNode *node, void (*free_item)(void *));
+void rtree_results_push(RTreeResults *results, void *item);
+
+#endif
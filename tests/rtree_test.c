@@ -0,0 +1,106 @@
+// randomized insert/remove against a brute force scan, no window needed
+#include "../rtree.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ITEMS 2000
+#define STEPS 30000
+#define CHECK_EVERY 250
+
+static int items[ITEMS];
+static SDL_FRect bounds[ITEMS];
+static bool present[ITEMS];
+
+static void fail(const char *message) {
+    fprintf(stderr, "rtree_test: %s\n", message);
+    exit(1);
+}
+
+// checks parent links, fill factors, cached bounds and that every leaf sits
+// at the same depth, returns the number of items under node
+static int check_node(RTreeNode *node, RTreeNode *parent, int depth,
+                      int *leaf_depth) {
+    int count = 0;
+    if (node->parent != parent)
+        fail("stale parent pointer");
+    if (node->count > RTREE_MAX_ENTRIES)
+        fail("node overflow");
+    if (parent != NULL && node->count < RTREE_MIN_ENTRIES)
+        fail("node underflow");
+
+    for (int i = 0; i < node->count; i++) {
+        if (node->leaf) {
+            if (*leaf_depth < 0)
+                *leaf_depth = depth;
+            else if (*leaf_depth != depth)
+                fail("unbalanced tree");
+            count++;
+            continue;
+        }
+        SDL_FRect child = rtree_node_bounds(node->entries[i].child);
+        if (SDL_memcmp(&child, &node->entries[i].bounds, sizeof(child)) != 0)
+            fail("stale node bounds");
+        count +=
+            check_node(node->entries[i].child, node, depth + 1, leaf_depth);
+    }
+    return count;
+}
+
+static SDL_FRect random_rect(int extent, int size) {
+    return (SDL_FRect){rand() % extent, rand() % extent, rand() % size,
+                       rand() % size};
+}
+
+int main(void) {
+    RTreeNode *root = NULL;
+    int alive = 0;
+    srand(1);
+
+    for (int step = 0; step < STEPS; step++) {
+        int k = rand() % ITEMS;
+        if (present[k]) {
+            rtree_remove(&root, &items[k], bounds[k]);
+            alive--;
+        } else {
+            bounds[k] = random_rect(1000, 50);
+            rtree_insert(&root, &items[k], bounds[k]);
+            alive++;
+        }
+        present[k] = !present[k];
+
+        if (step % CHECK_EVERY != 0)
+            continue;
+
+        int leaf_depth = -1;
+        if ((root ? check_node(root, NULL, 0, &leaf_depth) : 0) != alive)
+            fail("item count mismatch");
+
+        SDL_FRect query = random_rect(1000, 200);
+        RTreeResults results = {0};
+        rtree_search(root, &query, &results);
+        int expected = 0;
+        for (int i = 0; i < ITEMS; i++) {
+            if (present[i] && rect_overlaps(&bounds[i], &query))
+                expected++;
+        }
+        for (int i = 0; i < results.count; i++) {
+            int index = (int *)results.items[i] - items;
+            if (!present[index] || !rect_overlaps(&bounds[index], &query))
+                fail("search returned a wrong item");
+        }
+        if (results.count != expected)
+            fail("search missed items");
+        free(results.items);
+    }
+
+    for (int i = 0; i < ITEMS; i++) {
+        if (present[i])
+            rtree_remove(&root, &items[i], bounds[i]);
+    }
+    if (root != NULL && root->count != 0)
+        fail("tree not empty after removing everything");
+    rtree_free(root, NULL);
+
+    printf("rtree_test: ok\n");
+    return 0;
+}